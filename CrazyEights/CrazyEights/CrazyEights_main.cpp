@@ -8,6 +8,7 @@
 
 #include <locale>
 #include "CardLibrary.hpp"
+#include "Tournament.hpp"
 
 bool emptyDeck = false;
 string getCmd = "", cmd = "";
@@ -20,10 +21,70 @@ void printDiscard() {
 	cout << "\n\n\t\t" << discardCard.getRank() + discardCard.getSuit() << "\n" << endl;
 }
 
-int main() {
+// Largest games per pairing accepted on the command line
+long const MAX_TOURNAMENT_GAMES = 1000000;
+
+// Prints how to start a tournament
+void printTournamentUsage() {
+	cout << "Usage: CrazyEights TOURNAMENT [max games per pairing, even number from 2 to " << MAX_TOURNAMENT_GAMES << "]" << endl;
+}
+
+// Runs the bot tournament instead of a two player game
+// Optional argument: maximum number of games per pairing
+int runTournament(int argc, char* argv[]) {
+	RandomStrategy randomBot;
+	FirstCardStrategy firstCardBot;
+	GreedyStrategy greedyBot;
+	TournamentSettings settings;
+
+	if(argc > 3) {
+		cout << "Too many arguments." << endl;
+		printTournamentUsage();
+		return 1;
+	}
+
+	if(argc > 2) {
+		stringstream ss(argv[2]);
+		long maxGames = 0;
+		char extra;
+
+		// Must be a whole number of mirrored pairs (2 games each)
+		if(!(ss >> maxGames) || ss >> extra || maxGames < 2 || maxGames > MAX_TOURNAMENT_GAMES || maxGames % 2 != 0) {
+			cout << "Invalid maximum number of games: " << argv[2] << endl;
+			printTournamentUsage();
+			return 1;
+		}
+
+		settings.maxPairs = (unsigned)(maxGames / 2);
+	}
+
+	vector<Strategy*> strategies;
+	strategies.push_back(&randomBot);
+	strategies.push_back(&firstCardBot);
+	strategies.push_back(&greedyBot);
+
+	Tournament tournament(strategies, settings);
+	tournament.run();
+	tournament.printResults();
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
 	int playNum = 0;
 	bool validTurn = false, isPlayer1Turn = true;
 
+	// TOURNAMENT argument plays the bots against each other
+	if(argc > 1) {
+		string arg = argv[1];
+		string mode = "";
+
+		for(size_t i = 0; i < arg.length(); i++)
+			mode += toupper(arg[i],loc);
+
+		if(mode == "TOURNAMENT")
+			return runTournament(argc, argv);
+	}
+
 	// Create the deck and the discard pile
 	ch.generateDeck();
 	ch.setupDiscard();
@@ -0,0 +1,692 @@
+/* Project: Crazy Eights
+ * Description: Bot strategies and a tournament runner used to benchmark them.
+ *              Every pair of strategies plays round-robin matches with mirrored
+ *              seeds on all cores, results feed incremental Elo/win-rate estimates,
+ *              and a pairing stops early once its confidence interval is tight enough
+ *              or one strategy is clearly ahead.
+ */
+
+#ifndef __TOURNAMENT_H__
+#define __TOURNAMENT_H__
+
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <cmath>
+#include "CardLibrary.hpp"
+
+// Rank indexes of the special cards (see rankName)
+unsigned const RANK_TWO = 0, RANK_EIGHT = 6, RANK_QUEEN = 10, RANK_ACE = 12;
+
+// Turn limit for a bot game, the game is a draw once it is reached
+unsigned const MAX_TURNS_PER_GAME = 1000;
+
+// Returns true if the card can be played on top of the discard pile
+bool isPlayable(const Card &c, const Card &top, unsigned currentSuit) {
+	return c.rankID_ == top.rankID_ || c.suitID_ == currentSuit;
+}
+
+// Strategy class - base class for the bots
+// A single strategy object is shared by every thread, so it must not keep any
+// game state of its own, all randomness comes from the generator it is passed
+class Strategy
+{
+public:
+	virtual ~Strategy() {}
+
+	// Name used when printing the results
+	virtual string getName() const = 0;
+
+	// Return the cards to play from the hand, an empty deck means pass (draw a card)
+	// Multiple cards must all share the rank of the first card played
+	virtual Deck chooseCards(const Deck &hand, const Card &top, unsigned currentSuit, mt19937 &rng) const = 0;
+
+	// Return the suit to change to after an 8 was played
+	// Default picks the suit the player holds the most of
+	virtual unsigned chooseSuit(const Deck &hand, mt19937 &/*rng*/) const {
+		unsigned count[Card::NUM_SUITS] = {0, 0, 0, 0};
+		unsigned best = 0;
+
+		for(size_t i = 0; i < hand.size(); i++)
+			count[hand[i].suitID_] += 1;
+
+		for(unsigned s = 1; s < Card::NUM_SUITS; s++) {
+			if(count[s] > count[best])
+				best = s;
+		}
+		return best;
+	}
+};
+
+// Plays a random playable card and changes to a random suit
+class RandomStrategy : public Strategy
+{
+public:
+	string getName() const { return "Random"; }
+
+	Deck chooseCards(const Deck &hand, const Card &top, unsigned currentSuit, mt19937 &rng) const {
+		Deck playable, cards;
+
+		for(size_t i = 0; i < hand.size(); i++) {
+			if(isPlayable(hand[i], top, currentSuit))
+				playable.push_back(hand[i]);
+		}
+
+		if(playable.size() > 0) {
+			uniform_int_distribution<size_t> pick(0, playable.size() - 1);
+			cards.push_back(playable[pick(rng)]);
+		}
+		return cards;
+	}
+
+	unsigned chooseSuit(const Deck &/*hand*/, mt19937 &rng) const {
+		uniform_int_distribution<unsigned> pick(0, Card::NUM_SUITS - 1);
+		return pick(rng);
+	}
+};
+
+// Plays the first playable card in the hand, one card at a time
+class FirstCardStrategy : public Strategy
+{
+public:
+	string getName() const { return "FirstCard"; }
+
+	Deck chooseCards(const Deck &hand, const Card &top, unsigned currentSuit, mt19937 &/*rng*/) const {
+		Deck cards;
+
+		for(size_t i = 0; i < hand.size(); i++) {
+			if(isPlayable(hand[i], top, currentSuit)) {
+				cards.push_back(hand[i]);
+				break;
+			}
+		}
+		return cards;
+	}
+};
+
+// Empties the hand as fast as possible
+// Plays the largest group of same rank cards it can and keeps 8s as a last resort
+class GreedyStrategy : public Strategy
+{
+public:
+	string getName() const { return "Greedy"; }
+
+	Deck chooseCards(const Deck &hand, const Card &top, unsigned currentSuit, mt19937 &/*rng*/) const {
+		Deck cards;
+		int bestIndex = -1;
+		size_t bestCount = 0;
+
+		for(size_t i = 0; i < hand.size(); i++) {
+			if(!isPlayable(hand[i], top, currentSuit))
+				continue;
+
+			// Count the cards of the same rank that can be stacked on this one
+			size_t count = 0;
+			for(size_t j = 0; j < hand.size(); j++) {
+				if(hand[j].rankID_ == hand[i].rankID_)
+					count += 1;
+			}
+
+			// Eights only get played when nothing else can be
+			bool isEight = hand[i].rankID_ == RANK_EIGHT;
+			bool bestIsEight = bestIndex >= 0 && hand[bestIndex].rankID_ == RANK_EIGHT;
+
+			if(bestIndex < 0 || (bestIsEight && !isEight) || (isEight == bestIsEight && count > bestCount)) {
+				bestIndex = (int)i;
+				bestCount = count;
+			}
+		}
+
+		// Play the chosen card first, followed by the rest of its rank
+		if(bestIndex >= 0) {
+			cards.push_back(hand[bestIndex]);
+			for(size_t j = 0; j < hand.size(); j++) {
+				if(j != (size_t)bestIndex && hand[j].rankID_ == hand[bestIndex].rankID_)
+					cards.push_back(hand[j]);
+			}
+		}
+		return cards;
+	}
+};
+
+// Match class - a single two player game between bots
+// Keeps its own deck and discard pile (unlike CardHandler, which uses the global ones)
+// so that matches can run on several threads at once
+class Match
+{
+public:
+	// Constructor - the seed decides the shuffle, so two matches with the same
+	// seed and swapped strategies deal the same cards to the opposite seats
+	// Each strategy gets its own generator (picked by its stream number), so its
+	// choices never change the cards, and it makes the same choices in both seats
+	Match(const Strategy &first, const Strategy &second, unsigned seed, unsigned firstStream = 0, unsigned secondStream = 1) {
+		seats_[0] = &first;
+		seats_[1] = &second;
+
+		// Stream 0 is the deal, strategy streams start at 1
+		seedRng(dealRng_, seed, 0);
+		seedRng(strategyRng_[0], seed, firstStream + 1);
+		seedRng(strategyRng_[1], seed, secondStream + 1);
+	}
+
+	// Play the game until someone empties their hand
+	// Returns the winning seat (0 or 1), or -1 if the turn limit was reached
+	int play() {
+		// Creates a card of each rank for each suit (52 cards total) and shuffles them
+		deck_.clear();
+		for(unsigned i = 0; i < Card::NUM_SUITS; ++i) {
+			for(unsigned j = 0; j < Card::NUM_RANKS; ++j)
+				deck_.push_back(Card(i,j));
+		}
+		shuffle(deck_.begin(), deck_.end(), dealRng_);
+
+		// Same order as a regular game: discard pile first, then the hands
+		discard_.clear();
+		discard_.push_back(deck_.back());
+		deck_.pop_back();
+		currentSuit_ = discard_.back().suitID_;
+
+		for(int s = 0; s < 2; s++) {
+			hands_[s].clear();
+			drawCard(s, MAX_CARDS_PER_HAND);
+		}
+
+		numCardsExtraDraw_ = 0;
+		numCardsDrawn_ = 1;
+		numSkippedTurns_ = 0;
+
+		// Turns alternate like main() does, an Ace doesn't change anything with two players
+		for(unsigned turn = 0; turn < MAX_TURNS_PER_GAME; turn++) {
+			int seat = turn % 2;
+
+			// Draw 2 was previously played, player has to draw the extra cards
+			if(numCardsDrawn_ > 1) {
+				drawCard(seat, numCardsDrawn_);
+				numCardsDrawn_ = 1;
+			}
+
+			// Queen was previously played, player turn is skipped
+			if(numSkippedTurns_ > 0) {
+				numSkippedTurns_ -= 1;
+				continue;
+			}
+
+			// An invalid play from a bot counts as a pass
+			Deck cards = seats_[seat]->chooseCards(hands_[seat], discard_.back(), currentSuit_, strategyRng_[seat]);
+			if(cards.size() == 0 || !playCards(seat, cards)) {
+				drawCard(seat, numCardsDrawn_);
+				continue;
+			}
+
+			if(hands_[seat].size() == 0)
+				return seat;
+		}
+
+		return -1;
+	}
+
+private:
+	const Strategy *seats_[2];
+	mt19937 dealRng_, strategyRng_[2];
+	Deck deck_, discard_, hands_[2];
+	unsigned currentSuit_;
+	int numCardsExtraDraw_, numCardsDrawn_, numSkippedTurns_;
+
+	// Seed a generator from the match seed and a stream number
+	static void seedRng(mt19937 &rng, unsigned seed, unsigned stream) {
+		unsigned values[2] = {seed, stream};
+		seed_seq seq(values, values + 2);
+		rng.seed(seq);
+	}
+
+	// Draw a number of cards and put them in the seat's hand
+	void drawCard(int seat, int numCards) {
+		for(int i = 0; i < numCards; i++) {
+			// No cards available, shuffle all but the top of the discard pile into the deck
+			if(deck_.size() == 0) {
+				if(discard_.size() <= 1)
+					break;
+
+				deck_.assign(discard_.begin(), discard_.end() - 1);
+				discard_.erase(discard_.begin(), discard_.end() - 1);
+				shuffle(deck_.begin(), deck_.end(), dealRng_);
+			}
+
+			hands_[seat].push_back(deck_.back());
+			deck_.pop_back();
+		}
+	}
+
+	// Play the cards the bot chose onto the discard pile, follows CardHandler::playCards
+	// except for 8s: CardHandler overwrites the chosen suit with the 8's own suit right
+	// after the prompt, so the suit never changes there, here the chosen suit is kept
+	// Returns false (and leaves the game untouched) if the play is invalid
+	bool playCards(int seat, const Deck &cards) {
+		Deck &hand = hands_[seat];
+		vector<bool> used(hand.size(), false);
+
+		// First card must match the discard pile, the rest must match its rank
+		if(!isPlayable(cards[0], discard_.back(), currentSuit_))
+			return false;
+
+		for(size_t i = 0; i < cards.size(); i++) {
+			if(cards[i].rankID_ != cards[0].rankID_)
+				return false;
+
+			// Each card has to be in the hand (and only be played once)
+			bool found = false;
+			for(size_t j = 0; j < hand.size() && !found; j++) {
+				if(!used[j] && hand[j].rankID_ == cards[i].rankID_ && hand[j].suitID_ == cards[i].suitID_) {
+					used[j] = true;
+					found = true;
+				}
+			}
+			if(!found)
+				return false;
+		}
+
+		// Move the cards from the hand to the discard pile
+		for(size_t i = 0; i < cards.size(); i++) {
+			for(size_t j = 0; j < hand.size(); j++) {
+				if(hand[j].rankID_ == cards[i].rankID_ && hand[j].suitID_ == cards[i].suitID_) {
+					hand.erase(hand.begin() + j);
+					break;
+				}
+			}
+			discard_.push_back(cards[i]);
+		}
+
+		// Special/wild card effects
+		unsigned rank = cards[0].rankID_;
+		int numPlayed = (int)cards.size();
+
+		if(rank == RANK_TWO) { // next player picks up 2 more cards per 2
+			numCardsExtraDraw_ += 2 * numPlayed;
+			numCardsDrawn_ = numCardsExtraDraw_;
+		}
+		else {
+			numCardsExtraDraw_ = 0;
+		}
+
+		if(rank == RANK_QUEEN) // Miss a turn per Queen
+			numSkippedTurns_ = numPlayed;
+
+		if(rank == RANK_EIGHT) // change suit, as described in the rules (see above)
+			currentSuit_ = seats_[seat]->chooseSuit(hand, strategyRng_[seat]) % Card::NUM_SUITS;
+		else
+			currentSuit_ = discard_.back().suitID_;
+
+		return true;
+	}
+};
+
+// Settings for a tournament
+struct TournamentSettings
+{
+	// Mirrored game pairs per pairing (each pair is two games)
+	unsigned minPairs, maxPairs;
+
+	// Early stopping: a pairing is done once the confidence interval of its
+	// score is narrower than +/- tolerance, or once one side is ahead by more
+	// than the sequential bound (false winner chance of at most alpha overall)
+	double confidenceZ, tolerance, alpha;
+
+	// Average Elo rating (ratings are fitted to all results, see Tournament::fitRatings)
+	double initialElo;
+
+	// Worker threads (0 = one per core) and the first seed used
+	unsigned numThreads, baseSeed;
+
+	TournamentSettings(): minPairs(20), maxPairs(1000), confidenceZ(1.96), tolerance(0.05), alpha(0.05),
+		initialElo(1500.0), numThreads(0), baseSeed(1) { }
+};
+
+// Game result that hasn't come back from a worker yet
+int const RESULT_PENDING = -2;
+
+// Results between two strategies, scores are from strategy A's point of view
+struct PairingResult
+{
+	size_t a, b;
+	unsigned pairsScheduled, pairsPlayed;
+	unsigned winsA, winsB, draws;
+	double scoreSum, scoreSqSum;
+	bool finished, stoppedEarly, decided;
+
+	// Games (and strategy A's total score in them) already used for the ratings
+	unsigned ratedGames;
+	double ratedScore;
+
+	// Winning seat of every game by seed index, A sits in seat 0 for even games
+	// Pairs can finish in any order, only the completed prefix counts
+	vector<int> results;
+
+	PairingResult(size_t first, size_t second, unsigned maxPairs): a(first), b(second), pairsScheduled(0), pairsPlayed(0),
+		winsA(0), winsB(0), draws(0), scoreSum(0), scoreSqSum(0), finished(false), stoppedEarly(false), decided(false),
+		ratedGames(0), ratedScore(0), results(2 * maxPairs, RESULT_PENDING) { }
+
+	// Score of strategy A in a game (1 = win, 0.5 = draw, 0 = loss)
+	double gameScore(unsigned game) const {
+		int seatA = game % 2;
+		if(results[game] == -1)
+			return 0.5;
+		return results[game] == seatA ? 1.0 : 0.0;
+	}
+
+	// Average score of strategy A (1 = always wins, 0.5 = even)
+	double mean() const { return pairsPlayed > 0 ? scoreSum / pairsPlayed : 0.5; }
+
+	// Half width of the confidence interval of the mean
+	// Each mirrored pair is one sample, which cancels out most of the luck of the deal
+	double halfWidth(double z) const {
+		if(pairsPlayed < 2)
+			return 1.0;
+
+		double m = mean();
+		double variance = (scoreSqSum - pairsPlayed * m * m) / (pairsPlayed - 1);
+		if(variance < 0)
+			variance = 0;
+		return z * sqrt(variance / pairsPlayed);
+	}
+
+	// Distance from 0.5 the mean must exceed to call a winner
+	// Hoeffding bound (pair scores are between 0 and 1) with alpha split over every
+	// look at the data, so checking after each pair doesn't inflate the error rate
+	double decisionBound(double alpha, unsigned numLooks) const {
+		if(pairsPlayed == 0)
+			return 1.0;
+		return sqrt(log(2.0 * numLooks / alpha) / (2.0 * pairsPlayed));
+	}
+};
+
+// Tournament class - plays every strategy against every other one
+class Tournament
+{
+public:
+	// Constructor - strategies are not owned and must outlive the tournament
+	Tournament(const vector<Strategy*> &strategies, TournamentSettings settings = TournamentSettings())
+		: strategies_(strategies), settings_(settings), nextPairing_(0), eloRound_(0), gamesPlayed_(0)
+	{
+		// At least one pair per pairing, and the early stop can't start after the last pair
+		if(settings_.maxPairs == 0)
+			settings_.maxPairs = 1;
+		if(settings_.minPairs > settings_.maxPairs)
+			settings_.minPairs = settings_.maxPairs;
+
+		elo_.assign(strategies_.size(), settings_.initialElo);
+		eloError_.assign(strategies_.size(), 0);
+
+		// Round-robin: every strategy plays every other one once
+		for(size_t i = 0; i < strategies_.size(); i++) {
+			for(size_t j = i + 1; j < strategies_.size(); j++)
+				pairings_.push_back(PairingResult(i, j, settings_.maxPairs));
+		}
+	}
+
+	// Play all pairings on the worker threads until each one is done
+	void run() {
+		unsigned numThreads = settings_.numThreads;
+		if(numThreads == 0)
+			numThreads = thread::hardware_concurrency();
+		if(numThreads == 0)
+			numThreads = 1;
+
+		vector<thread> workers;
+		for(unsigned i = 0; i < numThreads; i++)
+			workers.push_back(thread(&Tournament::worker, this));
+
+		for(size_t i = 0; i < workers.size(); i++)
+			workers[i].join();
+	}
+
+	// Print each pairing and the standings sorted by Elo
+	void printResults() {
+		lock_guard<mutex> lock(mutex_);
+
+		cout << "\n      ~~  TOURNAMENT RESULTS  ~~" << endl;
+		// Keep the stream's formatting to put it back afterwards
+		ios::fmtflags oldFlags = cout.flags();
+		streamsize oldPrecision = cout.precision();
+		cout << fixed << setprecision(3);
+
+		for(size_t i = 0; i < pairings_.size(); i++) {
+			const PairingResult &r = pairings_[i];
+			cout << setw(10) << strategies_[r.a]->getName() << " vs " << setw(10) << left << strategies_[r.b]->getName() << right
+				<< "  games: " << setw(5) << r.pairsPlayed * 2
+				<< "  W/L/D: " << r.winsA << "/" << r.winsB << "/" << r.draws
+				<< "  score: " << r.mean() << " +/- " << r.halfWidth(settings_.confidenceZ)
+				<< (r.stoppedEarly ? (r.decided ? "  (stopped early, decided)" : "  (stopped early, precise)") : "") << endl;
+		}
+
+		// Sort the strategies by Elo
+		vector<size_t> order;
+		for(size_t i = 0; i < strategies_.size(); i++)
+			order.push_back(i);
+		sort(order.begin(), order.end(), [this](size_t x, size_t y) { return elo_[x] > elo_[y]; });
+
+		// Win rate is the plain average of the strategy's score in each pairing, pairings
+		// stop after different numbers of games so pooling the games would weight them unevenly
+		vector<double> winRate(strategies_.size(), 0);
+		vector<unsigned> numPairings(strategies_.size(), 0);
+		for(size_t i = 0; i < pairings_.size(); i++) {
+			const PairingResult &r = pairings_[i];
+			winRate[r.a] += r.mean();
+			winRate[r.b] += 1.0 - r.mean();
+			numPairings[r.a] += 1;
+			numPairings[r.b] += 1;
+		}
+
+		cout << "\nStandings:" << endl;
+		for(size_t i = 0; i < order.size(); i++) {
+			size_t s = order[i];
+			cout << setw(3) << i + 1 << ". " << setw(10) << left << strategies_[s]->getName() << right
+				<< "  Elo: " << setprecision(1) << setw(7) << elo_[s] << " +/- " << setw(5) << eloError_[s]
+				<< "  win rate (avg over pairings): " << setprecision(3) << (numPairings[s] > 0 ? winRate[s] / numPairings[s] : 0) << endl;
+		}
+
+		unsigned maxGames = (unsigned)pairings_.size() * settings_.maxPairs * 2;
+		cout << "\nGames played: " << gamesPlayed_ << " of " << maxGames << " maximum." << endl;
+		cout.flags(oldFlags);
+		cout.precision(oldPrecision);
+	}
+
+	// Getters for the results
+	vector<PairingResult> getPairings() { lock_guard<mutex> lock(mutex_); return pairings_; }
+	vector<double> getElo() { lock_guard<mutex> lock(mutex_); return elo_; }
+	vector<double> getEloError() { lock_guard<mutex> lock(mutex_); return eloError_; }
+
+private:
+	vector<Strategy*> strategies_;
+	TournamentSettings settings_;
+	vector<PairingResult> pairings_;
+	vector<double> elo_, eloError_;
+	size_t nextPairing_;
+	unsigned eloRound_, gamesPlayed_;
+	mutex mutex_;
+
+	// Pulls mirrored game pairs off the schedule until there are none left
+	void worker() {
+		for(;;) {
+			size_t p;
+			unsigned pair;
+
+			{
+				lock_guard<mutex> lock(mutex_);
+				if(!nextJob(p, pair))
+					return;
+			}
+
+			// Every pairing uses the same seeds, so all of them see the same deals
+			unsigned seed = settings_.baseSeed + pair;
+
+			// Same deal twice with the seats swapped, each strategy keeps its own random stream
+			const PairingResult &r = pairings_[p];
+			const Strategy &a = *strategies_[r.a], &b = *strategies_[r.b];
+			int first = Match(a, b, seed, (unsigned)r.a, (unsigned)r.b).play();
+			int second = Match(b, a, seed, (unsigned)r.b, (unsigned)r.a).play();
+
+			lock_guard<mutex> lock(mutex_);
+			recordPair(p, pair, first, second);
+		}
+	}
+
+	// Pick the next pairing that still needs games, going round-robin over the pairings
+	// Must be called with the mutex held
+	bool nextJob(size_t &p, unsigned &pair) {
+		for(size_t n = 0; n < pairings_.size(); n++) {
+			size_t i = (nextPairing_ + n) % pairings_.size();
+			PairingResult &r = pairings_[i];
+
+			if(!r.finished && r.pairsScheduled < settings_.maxPairs) {
+				pair = r.pairsScheduled;
+				r.pairsScheduled += 1;
+				nextPairing_ = i + 1;
+				p = i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Store a finished pair of games, then add every pair that completes the
+	// prefix in seed order, so the results don't depend on thread timing
+	// Must be called with the mutex held
+	void recordPair(size_t p, unsigned pair, int first, int second) {
+		PairingResult &r = pairings_[p];
+		r.results[2 * pair] = first;
+		r.results[2 * pair + 1] = second;
+
+		while(!r.finished && r.results[2 * r.pairsPlayed] != RESULT_PENDING && r.results[2 * r.pairsPlayed + 1] != RESULT_PENDING) {
+			for(unsigned g = 2 * r.pairsPlayed; g <= 2 * r.pairsPlayed + 1; g++) {
+				double scoreA = r.gameScore(g);
+				if(scoreA == 1.0)
+					r.winsA += 1;
+				else if(scoreA == 0.0)
+					r.winsB += 1;
+				else
+					r.draws += 1;
+			}
+
+			double score = (r.gameScore(2 * r.pairsPlayed) + r.gameScore(2 * r.pairsPlayed + 1)) / 2;
+			r.scoreSum += score;
+			r.scoreSqSum += score * score;
+			r.pairsPlayed += 1;
+
+			// Stop once the interval is tight enough or one side is clearly ahead
+			// Pairs still being played past this point are thrown away
+			if(r.pairsPlayed >= settings_.minPairs) {
+				unsigned numLooks = settings_.maxPairs - settings_.minPairs + 1;
+				r.decided = fabs(r.mean() - 0.5) > r.decisionBound(settings_.alpha, numLooks);
+
+				if(r.decided || r.halfWidth(settings_.confidenceZ) <= settings_.tolerance) {
+					r.finished = true;
+					r.stoppedEarly = r.pairsPlayed < settings_.maxPairs;
+				}
+			}
+
+			if(r.pairsPlayed >= settings_.maxPairs)
+				r.finished = true;
+		}
+
+		updateElo();
+	}
+
+	// Stream the counted games into the Elo ratings one seed at a time, once every
+	// pairing still playing has that seed, then refit the ratings to all games so far
+	// Must be called with the mutex held
+	void updateElo() {
+		for(;;) {
+			bool hasGames = false;
+
+			for(size_t i = 0; i < pairings_.size(); i++) {
+				if(pairings_[i].pairsPlayed > eloRound_)
+					hasGames = true;
+				else if(!pairings_[i].finished)
+					return;
+			}
+
+			if(!hasGames)
+				return;
+
+			for(size_t i = 0; i < pairings_.size(); i++) {
+				if(pairings_[i].pairsPlayed > eloRound_) {
+					rateGame(pairings_[i], pairings_[i].gameScore(2 * eloRound_));
+					rateGame(pairings_[i], pairings_[i].gameScore(2 * eloRound_ + 1));
+				}
+			}
+			eloRound_ += 1;
+			fitRatings();
+		}
+	}
+
+	// Maximum likelihood Elo (Bradley-Terry model) from the total score of every pairing,
+	// so every game counts the same instead of the latest ones counting the most
+	// Each pairing gets one extra virtual draw so a strategy that never wins (or never
+	// loses) still gets a finite rating
+	// Must be called with the mutex held
+	void fitRatings() {
+		size_t n = strategies_.size();
+		vector<double> score(n, 0), strength(n, 1.0);
+
+		for(size_t i = 0; i < pairings_.size(); i++) {
+			const PairingResult &r = pairings_[i];
+			score[r.a] += r.ratedScore + 0.5;
+			score[r.b] += r.ratedGames - r.ratedScore + 0.5;
+		}
+
+		// Minorization-maximization updates, converges in a few dozen iterations
+		for(int iter = 0; iter < 200; iter++) {
+			vector<double> expected(n, 0);
+
+			for(size_t i = 0; i < pairings_.size(); i++) {
+				const PairingResult &r = pairings_[i];
+				double games = r.ratedGames + 1.0;
+				double perStrength = games / (strength[r.a] + strength[r.b]);
+				expected[r.a] += perStrength;
+				expected[r.b] += perStrength;
+			}
+
+			// Keep the geometric mean at 1 so the average rating stays at initialElo
+			double logSum = 0, change = 0;
+			for(size_t s = 0; s < n; s++) {
+				double updated = score[s] / expected[s];
+				change = max(change, fabs(log(updated / strength[s])));
+				strength[s] = updated;
+				logSum += log(updated);
+			}
+			for(size_t s = 0; s < n; s++)
+				strength[s] /= exp(logSum / n);
+
+			if(change < 1e-9)
+				break;
+		}
+
+		// Error from the curvature of the likelihood for each rating on its own
+		vector<double> information(n, 0);
+		for(size_t i = 0; i < pairings_.size(); i++) {
+			const PairingResult &r = pairings_[i];
+			double p = strength[r.a] / (strength[r.a] + strength[r.b]);
+			double info = (r.ratedGames + 1.0) * p * (1 - p);
+			information[r.a] += info;
+			information[r.b] += info;
+		}
+
+		double eloPerLog = 400.0 / log(10.0);
+		for(size_t s = 0; s < n; s++) {
+			elo_[s] = settings_.initialElo + eloPerLog * log(strength[s]);
+			eloError_[s] = information[s] > 0 ? settings_.confidenceZ * eloPerLog / sqrt(information[s]) : 0;
+		}
+	}
+
+	// Add one game to the totals the ratings are fitted to
+	void rateGame(PairingResult &r, double scoreA) {
+		gamesPlayed_ += 1;
+
+		r.ratedGames += 1;
+		r.ratedScore += scoreA;
+	}
+};
+
+
+#endif